@@ -2,8 +2,27 @@
 // TODO :
 // - gradually fade in-out stressors
 
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string.h>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <sys/resource.h>
+#else
+#include <direct.h>
+#endif
+#include <thread>
+#include <vector>
 #include "al/app/al_DistributedApp.hpp"
 #include "al/app/al_GUIDomain.hpp"
 #include "al/graphics/al_Image.hpp"
@@ -19,14 +38,211 @@ using namespace al;
 using namespace std;
 using namespace gam;
 
-static const int years = 11;     // Total number of years (2003~2013)
-static const int stressors = 12; // Total number of stressors
+static const int years = 11;     // Total number of years in the CHI data (2003~2013)
+static const int stressors = 12; // Total number of stressors in the CHI data
+
+// Raster of stressor p for a year is data/chi/<prefix><year><suffix>
+struct StressorFiles
+{
+  const char *name;
+  const char *prefix;
+  const char *suffix;
+};
+
+static const StressorFiles stressorFiles[stressors] = {
+    {"SST", "sst/sst_05_", "_equi.png"},
+    {"Nutrients", "nutrient/nutrient_pollution_impact_5_", "_equi.png"},
+    {"Shipping", "ship/ship_impact_10_", "_equi.png"},
+    {"Ocean Acidification", "oa/oa_10_", "_impact.png"},
+    {"Sea level rise", "slr/slr_impact_5_", "_equi.png"},
+    {"Fishing demersal low", "fish/fdl_10_", "_impact.png"},
+    {"Fishing demersal high", "fish/fdh_10_", "_impact.png"},
+    {"Fishing pelagic low", "fish/fpl_10_", "_impact.png"},
+    {"Fishing pelagic high", "fish/fph_100_", "_impact.png"},
+    {"Direct human", "dh/dh_10_", "_impact.png"},
+    {"Organic chemical", "oc/oc_10_", "_impact.png"},
+    {"Cumulative human impacts", "chi/cumulative_impact_10_", ".png"}};
+
+static std::string rasterPath(int d, int p)
+{
+  ostringstream ostr;
+  ostr << "data/chi/" << stressorFiles[p].prefix << d + 2003 << stressorFiles[p].suffix;
+  return ostr.str();
+}
+
+// Scratch raster the scaling suite writes for step d of synthetic stressor p
+static std::string scalingPath(int d, int p)
+{
+  ostringstream ostr;
+  ostr << "data/scaling/stressor" << p << "_" << d << ".png";
+  return ostr.str();
+}
+
+// Modification time, to the nanosecond where the platform has it, and size of a file
+struct FileStamp
+{
+  bool exists{false};
+  long long seconds{0};
+  long long nanoseconds{0};
+  long long size{0};
+
+  bool operator==(const FileStamp &other) const
+  {
+    return exists == other.exists && seconds == other.seconds &&
+           nanoseconds == other.nanoseconds && size == other.size;
+  }
+  bool operator!=(const FileStamp &other) const { return !(*this == other); }
+};
+
+static FileStamp fileStamp(const std::string &path)
+{
+  FileStamp stamp;
+  struct stat st;
+  if (stat(path.c_str(), &st) != 0)
+    return stamp;
+  stamp.exists = true;
+  stamp.seconds = st.st_mtime;
+#if defined(__APPLE__)
+  stamp.nanoseconds = st.st_mtimespec.tv_nsec;
+#elif defined(__linux__)
+  stamp.nanoseconds = st.st_mtim.tv_nsec;
+#endif
+  stamp.size = st.st_size;
+  return stamp;
+}
+
+// Single-channel stressor raster, top row first; 0 is land / no data
+struct Raster
+{
+  int width{0};
+  int height{0};
+  std::vector<unsigned char> values;
+};
+
+// Keep only the red channel of a greyscale image, a quarter of the RGBA footprint
+static Raster loadRaster(const std::string &filename)
+{
+  Image image(filename);
+  Raster raster;
+  raster.width = image.width();
+  raster.height = image.height();
+  const size_t n = size_t(raster.width) * raster.height;
+  const unsigned char *pixels = image.array().data();
+  raster.values.resize(image.array().size() >= 4 * n ? n : 0);
+  for (size_t i = 0; i < raster.values.size(); i++)
+    raster.values[i] = pixels[4 * i];
+  if (raster.values.empty())
+    raster.width = raster.height = 0;
+  return raster;
+}
+
+static unsigned hashCell(unsigned a, unsigned b, unsigned c)
+{
+  unsigned h = a * 0x9E3779B1u ^ (b + 0x7F4A7C15u) * 0x85EBCA77u ^ (c + 0x165667B1u) * 0xC2B2AE3Du;
+  h ^= h >> 15;
+  h *= 0x2C1B3C6Du;
+  h ^= h >> 12;
+  h *= 0x297A2D39u;
+  h ^= h >> 15;
+  return h;
+}
+
+static float hash01(unsigned a, unsigned b, unsigned c)
+{
+  return (hashCell(a, b, c) >> 8) * (1.f / 16777216.f);
+}
+
+// Generator of synthetic equirectangular stressor rasters for scaling tests.
+// Each raster is a smooth per-stressor field with a spatially varying drift
+// over time; land comes in blocks shared by all stressors and years.
+// The default is 1/20 of the 3861x1930 CHI grid per axis, so that every scale
+// of the suite fits in memory; the suite's scales are multiples of this base.
+struct SyntheticDataset
+{
+  int width{193};
+  int height{97};
+  int years{11};
+  int stressors{12};
+  float sparsity{0.3f};  // fraction of land / no-data cells
+  float coherence{0.9f}; // 1: values drift smoothly between years, 0: independent noise
+  unsigned seed{1};
+  // land blocks on a fixed grid over the globe, about 32 cells wide at the CHI size,
+  // so the land fraction follows sparsity at every resolution
+  static const int blocksX = 120;
+  static const int blocksY = 60;
+
+  bool land(int x, int y) const
+  {
+    return hash01(seed, x * blocksX / width, y * blocksY / height) < sparsity;
+  }
+
+  Raster raster(int d, int p) const
+  {
+    Raster raster;
+    raster.width = width;
+    raster.height = height;
+    raster.values.resize(size_t(width) * height);
+
+    const float rowFreq = 1 + 4 * hash01(seed, p, 1), rowPhase = M_2PI * hash01(seed, p, 2);
+    const float colFreq = 1 + 8 * hash01(seed, p, 3), colPhase = M_2PI * hash01(seed, p, 4);
+    std::vector<float> rowWave(height), colWave(width);
+    for (int y = 0; y < height; y++)
+      rowWave[y] = sin(rowFreq * y * M_PI / height + rowPhase);
+    for (int x = 0; x < width; x++)
+      colWave[x] = sin(colFreq * x * M_2PI / width + colPhase);
+
+    const float t = years > 1 ? float(d) / (years - 1) : 0;
+    for (int y = 0; y < height; y++)
+    {
+      unsigned char *dst = raster.values.data() + size_t(y) * width;
+      for (int x = 0; x < width; x++)
+      {
+        if (land(x, y))
+        {
+          dst[x] = 0;
+          continue;
+        }
+        float base = 0.5f + 0.25f * rowWave[y] + 0.25f * colWave[x];
+        float drift = 0.3f * rowWave[y] * colWave[x] * t;
+        float noise = hash01(seed + d, p, y * width + x) - 0.5f;
+        float v = base + drift + (1 - coherence) * noise;
+        dst[x] = (unsigned char)std::max(1.f, std::min(255.f, 1 + v * 254));
+      }
+    }
+    return raster;
+  }
+};
+
+// Peak resident memory of the process in MB, 0 where unsupported
+static double peakMemoryMB()
+{
+#ifdef _WIN32
+  return 0;
+#else
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return usage.ru_maxrss / (1024.0 * 1024.0);
+#else
+  return usage.ru_maxrss / 1024.0;
+#endif
+#endif
+}
+
+// What is drawn for every enabled stressor, one mode at a time
+enum LayerMode
+{
+  LAYER_YEAR,    // value of the current year
+  LAYER_TREND,   // least-squares slope over all years
+  LAYER_ANOMALY  // current year's residual from the trend
+};
 
 struct State
 {
   Pose global_pose;
   bool swtch[stressors]{false};
   bool molph{false};
+  int layerMode{LAYER_YEAR};
   float lux;
   float year;
   float radius;
@@ -40,6 +256,91 @@ struct GeoLoc
   float radius;
 };
 
+// Distribution of one raster's values; bin 0 is land / no data
+struct RasterStats
+{
+  long long histogram[256]{0};
+  long long oceanCells{0};
+  double mean{0};
+
+  void add(const RasterStats &other)
+  {
+    for (int v = 0; v < 256; v++)
+      histogram[v] += other.histogram[v];
+    mean = (mean * oceanCells + other.mean * other.oceanCells) /
+           std::max(1LL, oceanCells + other.oceanCells);
+    oceanCells += other.oceanCells;
+  }
+
+  // Smallest ocean value with at least fraction q of ocean cells at or below it
+  int percentile(double q) const
+  {
+    long long count = 0;
+    for (int v = 1; v < 256; v++)
+    {
+      count += histogram[v];
+      if (count > 0 && count >= q * oceanCells)
+        return v;
+    }
+    return 0;
+  }
+};
+
+// Raster values a stressor's color ramp spans, from its loaded statistics
+struct Ramp
+{
+  float low{1};
+  float high{255};
+
+  // Position of raster value v on the ramp, in [0, 1]
+  float operator()(int v) const
+  {
+    return std::max(0.f, std::min(1.f, (v - low) / (high - low)));
+  }
+};
+
+// Histogram of a raster in a single pass over its values
+static void computeStats(const Raster &raster, RasterStats &stats)
+{
+  stats = RasterStats();
+  for (unsigned char v : raster.values)
+    stats.histogram[v]++;
+  double sum = 0;
+  for (int v = 1; v < 256; v++)
+  {
+    stats.oceanCells += stats.histogram[v];
+    sum += double(v) * stats.histogram[v];
+  }
+  stats.mean = stats.oceanCells > 0 ? sum / stats.oceanCells : 0;
+}
+
+// Layer rebuilt by the reload thread, waiting to be swapped in on the next frame
+struct ReloadedLayer
+{
+  int year, stressor;
+  Mesh mesh;
+  Color color;
+  std::chrono::steady_clock::time_point detected; // poll that first saw the change
+};
+
+// Trend and anomaly points of one band of raster rows, built by one worker thread
+struct DerivedBand
+{
+  std::vector<Vec3f> trendVerts;
+  std::vector<Color> trendColors;
+  std::vector<float> trendSlope;         // per trend point, dropped once colored
+  std::vector<long long> slopeHistogram; // |slope| counts, for the ramp percentile
+  std::vector<std::vector<Vec3f>> anomalyVerts; // per year
+  std::vector<std::vector<Color>> anomalyColors;
+};
+
+// Trend and anomaly points of one stressor, ready to be swapped into its meshes
+struct DerivedLayers
+{
+  int stressor{0};
+  std::vector<DerivedBand> bands;
+};
+
 struct SensoriumApp : public DistributedAppWithState<State>
 {
   VAOMesh skyMesh, sphereMesh;
@@ -67,10 +368,12 @@ struct SensoriumApp : public DistributedAppWithState<State>
   ParameterBool s_cf_dd{"Commercial fishing - demersal destructive", "", 0.0};
   ParameterBool a_f{"Artisanal fishing", "", 0.0};
   ParameterBool s_shp{"Shipping", "", 0.0};
+  ParameterMenu layerMode{"Show"};
 
 
   GeoLoc sourceGeoLoc, targetGeoLoc;
-  Image oceanData[years][stressors];
+  int numYears{0}, numStressors{0}; // size of the loaded layer set, see allocateLayers()
+  std::vector<std::vector<Raster>> oceanData; // [year][stressor]
   double morphProgress{0.0};
   double morphDuration{5.0};
   const double defaultMorph{5.0};
@@ -80,10 +383,39 @@ struct SensoriumApp : public DistributedAppWithState<State>
   Light light;
   float earth_radius = 5;
   float point_dist = 1.01 * earth_radius;
-  int data_W[stressors], data_H[stressors];
-  VAOMesh pic[years][stressors];
-  Color data_color[years][stressors];
+  std::vector<int> data_W, data_H;
+  std::vector<std::vector<VAOMesh>> pic;
+  std::vector<std::vector<Color>> data_color;
+  std::vector<std::vector<VAOMesh>> trendMesh;                // [stressor][band]
+  std::vector<std::vector<std::vector<VAOMesh>>> anomalyMesh; // [year][stressor][band]
   float morph_year;
+  const float anomalyZ{2.f}; // residual z-score marking a year as anomalous
+  static const int slopeBins = 4096;
+  // After onCreate, the rasters, their stamps and stats are owned by reloadThread
+  std::vector<std::vector<FileStamp>> rasterStamp; // file each layer was built from
+  std::vector<std::vector<FileStamp>> seenStamp;   // file at the previous poll
+  std::vector<std::vector<std::chrono::steady_clock::time_point>> seenTime; // when seenStamp changed
+  std::vector<std::vector<FileStamp>> failedStamp; // file that last failed to decode
+  std::vector<std::vector<RasterStats>> rasterStats;
+  std::vector<RasterStats> stressorStats; // all years combined
+  std::vector<Ramp> ramps;                // 1st to 99th percentile of each stressor
+  bool scalingSuite{false};               // run the scaling suite instead of the CHI data
+  SyntheticDataset scalingBase;
+  std::string scalingAxis{"steps"};
+  float scalingMaxGB{32};                 // host memory limit of the scaling suite
+  float scalingMaxGpuGB{8};               // GPU memory limit of the scaling suite
+  const std::vector<int> scalingScales{1, 10, 100};
+  static const int scalingFrames = 120;   // frames drawn and timed per scale
+  int scalingRun{-1};                     // index into scalingScales of the scale being drawn
+  int scalingFrame{0};
+  std::chrono::steady_clock::time_point scalingDrawStart;
+  std::ofstream scalingCsv;
+  std::string scalingRow;                 // columns of the current scale measured before drawing
+  std::thread reloadThread;
+  std::atomic<bool> watching{false};
+  std::mutex reloadLock;
+  std::vector<std::unique_ptr<ReloadedLayer>> reloadedLayers;
+  std::vector<DerivedLayers> reloadedDerived;
   std::shared_ptr<CuttleboneDomain<State>> cuttleboneDomain;
   gam::Buzz<> wave;
   gam::Sine<> env;
@@ -108,6 +440,10 @@ struct SensoriumApp : public DistributedAppWithState<State>
 
   void onCreate() override
   {
+    // one choice at a time: trend and anomaly replace the yearly layer of each enabled stressor
+    layerMode.setElements({"Yearly values",
+                           "Trend 2003-2013 (replaces yearly values)",
+                           "Anomaly from trend (replaces yearly values)"});
     lens().fovy(45).eyeSep(0);
     nav().pos(0, 0, -5);
     nav().quat().fromAxisAngle(0.5 * M_2PI, 0, 1, 0);
@@ -167,6 +503,7 @@ struct SensoriumApp : public DistributedAppWithState<State>
       *gui << lat << lon << radius << lux << year << gain;
       *gui << s_ci << s_oc << s_np << s_dh << s_slr << s_oa << s_sst;
       *gui << s_cf_pl << s_cf_ph << s_cf_dl << s_cf_dh << s_shp;
+      *gui << layerMode;
       // *gui << s_cf_dd << a_f // currently we don't have this data
       // *gui << s_ci << s_oc << s_np;
 
@@ -203,217 +540,44 @@ struct SensoriumApp : public DistributedAppWithState<State>
                                                         cos(lon.get() / 180.0 * M_PI)));
                                     nav().faceToward(Vec3d(0), Vec3d(0, 1, 0)); });
 
-    // Bring ocean data (image)
-    // 0. SST
+    if (scalingSuite)
+    {
+      startScalingSuite();
+      return;
+    }
+
+    // Bring ocean data (image), histogramming each raster as it arrives
     std::cout << "Start loading CHI data " << std::endl;
-    std::cout << "Start loading 0. SST" << std::endl;
-    int stress = 0;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/sst/sst_05_" << d + 2003 << "_equi.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      std::strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][0].primitive(Mesh::POINTS);
-    }
-    // 1. Nutrients
-    stress = 1;
-    std::cout << "Start loading 1. Nutrients" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/nutrient/nutrient_pollution_impact_5_" << d + 2003 << "_equi.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 2. Shipping
-    stress = 2;
-    std::cout << "Start loading 2. Shipping" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/ship/ship_impact_10_" << d + 2003 << "_equi.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 3. Ocean Acidification
-    stress = 3;
-    std::cout << "Start loading 3. Ocean Acidification " << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/oa/oa_10_" << d + 2003 << "_impact.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 4. Sea level rise
-    stress = 4;
-    std::cout << "Start loading 4. Sea level rise" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/slr/slr_impact_5_" << d + 2003 << "_equi.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 5. Fishing demersal low
-    stress = 5;
-    std::cout << "Start loading 5. Fishing demersal low " << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/fish/fdl_10_" << d + 2003 << "_impact.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 6. Fishing demersal high
-    stress = 6;
-    std::cout << "Start loading 6. Fishing demersal high " << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/fish/fdh_10_" << d + 2003 << "_impact.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 7. Fishing pelagic low
-    stress = 7;
-    std::cout << "Start loading 7. Fishing pelagic low" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/fish/fpl_10_" << d + 2003 << "_impact.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 8. Fishing pelagic high
-    stress = 8;
-    std::cout << "Start loading 8. Fishing pelagic high" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/fish/fph_100_" << d + 2003 << "_impact.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 9. Direct human
-    stress = 9;
-    std::cout << "Start loading 9. Direct human" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/dh/dh_10_" << d + 2003 << "_impact.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 10. Organic chemical
-    stress = 10;
-    std::cout << "Start loading 10. Organic chemical" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/oc/oc_10_" << d + 2003 << "_impact.png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    // 11. Cumulative human impacts
-    stress = 11;
-    std::cout << "Start loading 11. Cumulative human impacts" << std::endl;
-    for (int d = 0; d < years; d++)
-    {
-      ostringstream ostr;
-      ostr << "data/chi/chi/cumulative_impact_10_" << d + 2003 << ".png"; // ** change stressor
-      char *filename = new char[ostr.str().length() + 1];
-      strcpy(filename, ostr.str().c_str());
-      oceanData[d][stress] = Image(filename);
-      pic[d][stress].primitive(Mesh::POINTS);
-    }
-    std::cout << "Loaded CHI data" << std::endl;
+    auto loadStart = std::chrono::steady_clock::now();
+    allocateLayers(years, stressors);
+    loadLayers([&](int d, int p)
+               {
+                 std::string filename = rasterPath(d, p);
+                 rasterStamp[d][p] = seenStamp[d][p] = fileStamp(filename);
+                 return loadRaster(filename); });
+    std::cout << "Loaded CHI data in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count()
+              << " s" << std::endl;
 
-    // Assign color for data
-    for (int p = 0; p < stressors; p++)
+    summarizeStats();
+    normalizeRamps();
+    for (int p = 0; p < numStressors; p++)
     {
-      data_W[p] = oceanData[0][p].width();
-      data_H[p] = oceanData[0][p].height();
-      point_dist = 2.002 + 0.001 * p;
-      for (int d = 0; d < years; d++)
-      {
-        for (int row = 0; row < data_H[p]; row++)
-        {
-          double theta = row * M_PI / data_H[p];
-          double sinTheta = sin(theta);
-          double cosTheta = cos(theta);
-          for (int column = 0; column < data_W[p]; column++)
-          {
-            auto pixel = oceanData[d][p].at(column, data_H[p] - row - 1);
-            if (pixel.r > 0)
-            {
-              // {
-              double phi = column * M_2PI / data_W[p];
-              double sinPhi = sin(phi);
-              double cosPhi = cos(phi);
-
-              double x = sinPhi * sinTheta;
-              double y = -cosTheta;
-              double z = cosPhi * sinTheta;
-
-              pic[d][p].vertex(x * point_dist, y * point_dist, z * point_dist);
-              // init color config
-              if (p == 0) // sst color
-                data_color[d][p] = HSV(0.55 + log(pixel.r / 90. + 1), 0.65 + pixel.r / 60, 0.6 + atan(pixel.r / 300));
-              else if (p == 1) // nutrient pollution color
-                data_color[d][p] = (HSV(0.3 - log(pixel.r / 60. + 1), 0.9 + pixel.r / 90, 0.9 + pixel.r / 90));
-              else if (p == 2) // shipping color
-                data_color[d][p] = (HSV(1 - log(pixel.r / 30. + 1), 0.6 + pixel.r / 100, 0.6 + pixel.r / 60));
-              else if (p == 3) // Ocean Acidification
-                data_color[d][p] = (HSV(0.7 - 0.6 * log(pixel.r / 100. + 1), 0.5 + log(pixel.r / 100. + 1), 1));
-              // pic[d][p].color(HSV(0.6 + log(pixel.r/60. + 1), 0.96+log(pixel.r/60.+0.1), 0.98+log(pixel.r/60.+0.1)));
-              else if (p == 4) // sea level rise color
-                data_color[d][p] = (HSV(0.6 + 0.2 * log(pixel.r / 100. + 1), 0.6 + log(pixel.r / 60. + 1), 0.6 + log(pixel.r / 60. + 1)));
-              // pic[d][p].color(HSV(0.7-log(pixel.r/100.+ 0.1), 0.6+log(pixel.r/100.+0.1), 0.8+log(pixel.r/200.+1)));
-              else if (p == 5) // Fishing demersal low
-                data_color[d][p] = (HSV(log(pixel.r / 90. + 1), 0.9, 1));
-              else if (p == 6) // Fishing demersal high
-                data_color[d][p] =(HSV(log(pixel.r / 90. + 1), 0.9, 1));
-              else if (p == 7) // Fishing pelagic low
-                data_color[d][p] = (HSV(log(pixel.r / 90. + 1), 0.9, 1));
-              else if (p == 8) // Fishing pelagic high
-                data_color[d][p] = (HSV(log(pixel.r / 90. + 1), 0.9, 1));
-              else if (p == 9) // direct human
-                data_color[d][p] = (HSV(log(pixel.r / 120. + 1), 0.9, 1));
-              else if (p == 10) // ocean chem
-                data_color[d][p] = (HSV(log(pixel.r / 120. + 1), 0.9, 1));
-              else if (p == 11) // cumulative human impact
-                data_color[d][p] = (HSV(log(pixel.r / 120. + 1), 0.9, 1));
-              // end of assigning colors for data
-              pic[d][p].color(data_color[d][p]);
-            }
-          }
-        }
-        pic[d][p].update();
-      }
+      std::cout << p << ". " << stressorFiles[p].name << ": " << stressorStats[p].oceanCells
+                << " ocean cells, mean " << stressorStats[p].mean
+                << ", p99 " << stressorStats[p].percentile(0.99) << std::endl;
     }
+    saveStats();
+
+    // Assign color for data
+    buildLayers();
+
+    // Derive the trend / anomaly layers, then rebuild layers in the background
+    // when their raster changes on disk
+    watching = true;
+    reloadThread = std::thread([this]()
+                               { watchRasters(); });
+
     // audio
     // filter
     mFilter.zero();
@@ -425,8 +589,781 @@ struct SensoriumApp : public DistributedAppWithState<State>
 
   }
 
+  // Size every per-layer container for nYears x nStressors, dropping old layers
+  void allocateLayers(int nYears, int nStressors)
+  {
+    numYears = nYears;
+    numStressors = nStressors;
+    oceanData.assign(nYears, std::vector<Raster>(nStressors));
+    rasterStamp.assign(nYears, std::vector<FileStamp>(nStressors));
+    seenStamp.assign(nYears, std::vector<FileStamp>(nStressors));
+    seenTime.assign(nYears, std::vector<std::chrono::steady_clock::time_point>(nStressors));
+    failedStamp.assign(nYears, std::vector<FileStamp>(nStressors));
+    rasterStats.assign(nYears, std::vector<RasterStats>(nStressors));
+    data_color.assign(nYears, std::vector<Color>(nStressors));
+    pic = std::vector<std::vector<VAOMesh>>(nYears);
+    for (int d = 0; d < nYears; d++)
+      pic[d] = std::vector<VAOMesh>(nStressors);
+    // filled band by band by applyDerivedLayers()
+    anomalyMesh.assign(nYears, std::vector<std::vector<VAOMesh>>(nStressors));
+    trendMesh.assign(nStressors, std::vector<VAOMesh>());
+    data_W.assign(nStressors, 0);
+    data_H.assign(nStressors, 0);
+    stressorStats.assign(nStressors, RasterStats());
+    ramps.assign(nStressors, Ramp());
+  }
+
+  // Run job(year, stressor) for every layer on a pool of threads
+  static void forEachLayer(int nYears, int nStressors, const std::function<void(int, int)> &job)
+  {
+    std::atomic<int> nextLayer{0};
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < std::max(1u, std::thread::hardware_concurrency()); t++)
+    {
+      workers.emplace_back([&]()
+                           {
+                             int i;
+                             while ((i = nextLayer++) < nYears * nStressors)
+                               job(i % nYears, i / nYears); });
+    }
+    for (auto &worker : workers)
+      worker.join();
+  }
+
+  // Fill oceanData from source(year, stressor) on a pool of threads,
+  // histogramming each raster as soon as it arrives
+  void loadLayers(const std::function<Raster(int, int)> &source)
+  {
+    forEachLayer(numYears, numStressors, [&](int d, int p)
+                 {
+                   oceanData[d][p] = source(d, p);
+                   computeStats(oceanData[d][p], rasterStats[d][p]); });
+  }
+
+  // Stretch each stressor's color ramp over the 1st to 99th percentile of its ocean cells
+  void normalizeRamps()
+  {
+    for (int p = 0; p < numStressors; p++)
+    {
+      ramps[p].low = stressorStats[p].percentile(0.01);
+      ramps[p].high = std::max(ramps[p].low + 1, float(stressorStats[p].percentile(0.99)));
+    }
+  }
+
+  // Build and upload the point layer of every (year, stressor)
+  void buildLayers()
+  {
+    for (int p = 0; p < numStressors; p++)
+    {
+      data_W[p] = oceanData[0][p].width;
+      data_H[p] = oceanData[0][p].height;
+      for (int d = 0; d < numYears; d++)
+      {
+        pic[d][p].primitive(Mesh::POINTS);
+        buildLayer(oceanData[d][p], p, ramps[p], pic[d][p], data_color[d][p]);
+        pic[d][p].update();
+      }
+    }
+  }
+
+  // Bytes held by the rasters and the CPU copies of all layer meshes
+  double layerBytes()
+  {
+    double bytes = 0;
+    auto meshBytes = [](Mesh &mesh)
+    {
+      return double(mesh.vertices().size()) * sizeof(Vec3f) +
+             double(mesh.colors().size()) * sizeof(Color);
+    };
+    for (int p = 0; p < numStressors; p++)
+    {
+      for (auto &band : trendMesh[p])
+        bytes += meshBytes(band);
+      for (int d = 0; d < numYears; d++)
+      {
+        bytes += oceanData[d][p].values.size();
+        bytes += meshBytes(pic[d][p]);
+        for (auto &band : anomalyMesh[d][p])
+          bytes += meshBytes(band);
+      }
+    }
+    return bytes;
+  }
+
+  // Run the load, point build, trend and draw stages on synthetic data at 1x,
+  // 10x and 100x the size of scalingBase and report time and memory per stage,
+  // along with each size relative to the CHI data (11 years x 12 stressors at 3861x1930).
+  // The base grows along scalingAxis: time steps, stressors or resolution.
+  // Each scale is prepared by nextScalingRun() and then drawn for scalingFrames
+  // frames by drawScalingFrame(), so the suite spans several frames.
+  void startScalingSuite()
+  {
+    scalingCsv.open("scaling.csv");
+    scalingCsv << "base_multiple,chi_fraction,status,steps,stressors,width,height,cells,"
+                  "estimate_host_gb,estimate_gpu_gb,"
+                  "points,png_mb,load_s,build_s,derive_s,draw_ms,layer_mb,peak_rss_mb\n";
+    std::cout << "Scaling suite along " << scalingAxis << std::endl;
+#ifdef _WIN32
+    _mkdir("data/scaling");
+#else
+    mkdir("data/scaling", 0755);
+#endif
+    scalingRun = -1;
+    nextScalingRun();
+  }
+
+  // Prepare the next scale that fits the memory limits, or finish the suite
+  void nextScalingRun()
+  {
+    while (++scalingRun < int(scalingScales.size()))
+    {
+      const int scale = scalingScales[scalingRun];
+      SyntheticDataset data = scalingBase;
+      if (scalingAxis == "stressors")
+        data.stressors *= scale;
+      else if (scalingAxis == "resolution")
+      {
+        data.width = int(data.width * std::sqrt(double(scale)));
+        data.height = int(data.height * std::sqrt(double(scale)));
+      }
+      else // steps
+        data.years *= scale;
+
+      // Rasters, then points of the yearly, trend and anomaly meshes, which are
+      // held both in host memory and on the GPU, plus the trend slopes staged in
+      // the DerivedBands of the one stressor being derived. Anomalies are assumed
+      // to be the ~5% of values beyond anomalyZ.
+      const double grid = double(data.width) * data.height;
+      const double cells = grid * data.years * data.stressors;
+      const double chiFraction = cells / (3861.0 * 1930 * years * stressors);
+      const double oceanCells = grid * (1 - data.sparsity);
+      const double pointBytes = sizeof(Vec3f) + sizeof(Color);
+      const double anomalyFraction = 0.05;
+      const double meshBytes = oceanCells * data.stressors * pointBytes *
+                               (data.years + 1 + anomalyFraction * data.years);
+      const double stagingBytes = oceanCells * sizeof(float);
+      const double hostGB = (cells + meshBytes + stagingBytes) / 1e9;
+      const double gpuGB = meshBytes / 1e9;
+      const bool skipped = hostGB > scalingMaxGB || gpuGB > scalingMaxGpuGB;
+      ostringstream row;
+      row << scale << "," << chiFraction << "," << (skipped ? "skipped" : "ok") << "," << data.years << "," << data.stressors
+          << "," << data.width << "," << data.height << "," << (long long)cells << "," << hostGB << "," << gpuGB;
+      std::cout << scale << "x base (" << chiFraction << " of the CHI size): ";
+      if (skipped)
+      {
+        std::cout << "skipped, needs about " << hostGB << " GB of memory and " << gpuGB
+                  << " GB of GPU memory (limits " << scalingMaxGB << " GB and " << scalingMaxGpuGB
+                  << " GB, see --max-gb and --max-gpu-gb)" << std::endl;
+        scalingCsv << row.str() << ",,,,,,,,\n";
+        continue;
+      }
+
+      // Write the rasters as 8-bit greyscale PNGs like the CHI data, so that
+      // the load stage decodes files through loadRaster() as it does at startup
+      std::atomic<long long> pngBytes{0};
+      forEachLayer(data.years, data.stressors, [&](int d, int p)
+                   {
+                     Raster raster = data.raster(d, p);
+                     Image::saveImage(scalingPath(d, p), raster.values.data(), raster.width,
+                                      raster.height, false, 1);
+                     struct stat st;
+                     if (stat(scalingPath(d, p).c_str(), &st) == 0)
+                       pngBytes += st.st_size; });
+
+      auto start = std::chrono::steady_clock::now();
+      allocateLayers(data.years, data.stressors);
+      loadLayers([&](int d, int p)
+                 { return loadRaster(scalingPath(d, p)); });
+      summarizeStats();
+      normalizeRamps();
+      auto loaded = std::chrono::steady_clock::now();
+      buildLayers();
+      auto built = std::chrono::steady_clock::now();
+      for (int p = 0; p < numStressors; p++)
+        computeDerivedLayers(p);
+      auto derived = std::chrono::steady_clock::now();
+      forEachLayer(data.years, data.stressors, [&](int d, int p)
+                   { std::remove(scalingPath(d, p).c_str()); });
+
+      long long points = 0;
+      for (int d = 0; d < numYears; d++)
+        for (int p = 0; p < numStressors; p++)
+          points += pic[d][p].vertices().size();
+      double loadTime = std::chrono::duration<double>(loaded - start).count();
+      double buildTime = std::chrono::duration<double>(built - loaded).count();
+      double deriveTime = std::chrono::duration<double>(derived - built).count();
+      std::cout << data.years << " steps x " << data.stressors << " stressors at "
+                << data.width << "x" << data.height << ", " << points << " points | load "
+                << loadTime << " s, build " << buildTime << " s, derive " << deriveTime << " s"
+                << std::endl;
+      row << "," << points << "," << pngBytes / (1024.0 * 1024.0) << "," << loadTime << ","
+          << buildTime << "," << deriveTime;
+      scalingRow = row.str();
+
+      // Draw the first year of every stressor the GUI can show, as a curator would
+      for (int j = 0; j < stressors; j++)
+        state().swtch[j] = j < numStressors;
+      state().layerMode = LAYER_YEAR;
+      state().year = 2003;
+      state().radius = 5;
+      scalingFrame = 0;
+      return;
+    }
+
+    allocateLayers(0, 0);
+    scalingCsv.close();
+    std::cout << "Wrote scaling.csv" << std::endl;
+    quit();
+  }
+
+  // Time scalingFrames frames of the current scale, after one warm-up frame.
+  // Called at the end of onDraw().
+  void drawScalingFrame()
+  {
+    if (scalingRun >= int(scalingScales.size()))
+      return;
+    glFinish(); // wait for the GPU so the frame time includes the draw itself
+    if (scalingFrame++ == 0)
+    {
+      scalingDrawStart = std::chrono::steady_clock::now();
+      return;
+    }
+    if (scalingFrame <= scalingFrames)
+      return;
+
+    double drawMs = 1000 * std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                                         scalingDrawStart).count() / scalingFrames;
+    double layerMB = layerBytes() / (1024.0 * 1024.0);
+    std::cout << scalingScales[scalingRun] << "x base: draw " << drawMs << " ms per frame | layers "
+              << layerMB << " MB, peak RSS " << peakMemoryMB() << " MB" << std::endl;
+    scalingCsv << scalingRow << "," << drawMs << "," << layerMB << "," << peakMemoryMB() << "\n";
+    nextScalingRun();
+  }
+
+  // Color ramp of stressor p at position t in [0, 1], see Ramp
+  static Color rampColor(int p, float t)
+  {
+    if (p == 0) // sst color
+      return HSV(0.55 + 0.3 * t, 0.65 + 0.35 * t, 0.6 + 0.4 * t);
+    else if (p == 1) // nutrient pollution color
+      return HSV(0.3 - 0.3 * t, 0.9 + 0.1 * t, 0.9 + 0.1 * t);
+    else if (p == 2) // shipping color
+      return HSV(1 - 0.25 * t, 0.6 + 0.4 * t, 0.6 + 0.4 * t);
+    else if (p == 3) // Ocean Acidification
+      return HSV(0.7 - 0.3 * t, 0.5 + 0.5 * t, 1);
+    else if (p == 4) // sea level rise color
+      return HSV(0.6 + 0.15 * t, 0.6 + 0.4 * t, 0.6 + 0.4 * t);
+    else if (p <= 8) // Fishing demersal / pelagic, low / high
+      return HSV(0.7 * t, 0.9, 1);
+    else // direct human, ocean chem, cumulative human impact
+      return HSV(0.8 * t, 0.9, 1);
+  }
+
+  // Fill mesh with one point per ocean cell of a stressor raster.
+  // Only touches its arguments, so it is safe to call off the render thread.
+  // Returns the number of points.
+  static int buildLayer(const Raster &raster, int p, const Ramp &ramp, Mesh &mesh, Color &lastColor)
+  {
+    const int W = raster.width, H = raster.height;
+    const float dist = 2.002 + 0.001 * p;
+    const unsigned char *pixels = raster.values.data();
+    Color colors[256];
+    for (int v = 0; v < 256; v++)
+      colors[v] = rampColor(p, ramp(v));
+    int count = 0;
+    for (int row = 0; row < H; row++)
+    {
+      double theta = row * M_PI / H;
+      double sinTheta = sin(theta);
+      double cosTheta = cos(theta);
+      const unsigned char *src = pixels + size_t(H - row - 1) * W;
+      for (int column = 0; column < W; column++)
+      {
+        int r = src[column];
+        if (r > 0)
+        {
+          double phi = column * M_2PI / W;
+          double x = sin(phi) * sinTheta;
+          double y = -cosTheta;
+          double z = cos(phi) * sinTheta;
+
+          mesh.vertex(x * dist, y * dist, z * dist);
+          lastColor = colors[r];
+          mesh.color(lastColor);
+          count++;
+        }
+      }
+    }
+    return count;
+  }
+
+  // Poll the raster files and rebuild layers whose file changed or appeared.
+  // Runs on reloadThread, which also refits the trend of the affected stressors
+  // and rewrites the statistics; applyReloadedLayers() only swaps the results in.
+  void watchRasters()
+  {
+    // file names come from the CHI tables
+    assert(numYears <= years && numStressors <= stressors);
+    // Derived layers of the loaded data first: per-cell trend and anomaly across all years
+    auto deriveStart = std::chrono::steady_clock::now();
+    for (int p = 0; p < numStressors && watching; p++)
+    {
+      DerivedLayers layers = deriveLayers(p);
+      std::lock_guard<std::mutex> lock(reloadLock);
+      reloadedDerived.push_back(std::move(layers));
+    }
+    std::cout << "Computed trend/anomaly layers in "
+              << std::chrono::duration<double>(std::chrono::steady_clock::now() - deriveStart).count()
+              << " s on " << std::max(1u, std::thread::hardware_concurrency()) << " threads" << std::endl;
+
+    while (watching)
+    {
+      std::vector<std::unique_ptr<ReloadedLayer>> layers;
+      std::vector<bool> changed(numStressors, false);
+      for (int p = 0; p < numStressors && watching; p++)
+      {
+        for (int d = 0; d < numYears && watching; d++)
+        {
+          std::string filename = rasterPath(d, p);
+          FileStamp stamp = fileStamp(filename);
+          if (!stamp.exists || stamp == rasterStamp[d][p] || stamp == failedStamp[d][p])
+            continue;
+          if (stamp != seenStamp[d][p])
+          {
+            // wait until the file is unchanged for one poll, it may still be being written
+            seenStamp[d][p] = stamp;
+            seenTime[d][p] = std::chrono::steady_clock::now();
+            continue;
+          }
+
+          auto buildStart = std::chrono::steady_clock::now();
+          Raster raster = loadRaster(filename);
+          if (raster.values.empty())
+          {
+            std::cerr << "failed to decode " << filename << ", waiting for it to change" << std::endl;
+            failedStamp[d][p] = stamp;
+            continue;
+          }
+          rasterStamp[d][p] = stamp;
+          oceanData[d][p] = std::move(raster);
+          if (d == 0)
+          {
+            data_W[p] = oceanData[d][p].width;
+            data_H[p] = oceanData[d][p].height;
+          }
+          computeStats(oceanData[d][p], rasterStats[d][p]);
+
+          std::unique_ptr<ReloadedLayer> layer(new ReloadedLayer);
+          layer->year = d;
+          layer->stressor = p;
+          layer->detected = seenTime[d][p];
+          layer->mesh.primitive(Mesh::POINTS);
+          int points = buildLayer(oceanData[d][p], p, ramps[p], layer->mesh, layer->color);
+          std::cout << "Rebuilt " << filename << ": " << points << " points, decoded and built in "
+                    << std::chrono::duration<double>(std::chrono::steady_clock::now() - buildStart).count()
+                    << " s" << std::endl;
+          layers.push_back(std::move(layer));
+          changed[p] = true;
+        }
+      }
+
+      if (!layers.empty())
+      {
+        std::vector<DerivedLayers> derived;
+        auto deriveStart = std::chrono::steady_clock::now();
+        for (int p = 0; p < numStressors; p++)
+        {
+          if (changed[p])
+            derived.push_back(deriveLayers(p));
+        }
+        std::cout << "Refit trend of " << derived.size() << " stressor(s) in "
+                  << std::chrono::duration<double>(std::chrono::steady_clock::now() - deriveStart).count()
+                  << " s" << std::endl;
+        // ramps stay as loaded so the other layers keep their colors
+        summarizeStats();
+        saveStats();
+
+        std::lock_guard<std::mutex> lock(reloadLock);
+        for (auto &layer : layers)
+          reloadedLayers.push_back(std::move(layer));
+        for (auto &d : derived)
+          reloadedDerived.push_back(std::move(d));
+      }
+
+      for (int i = 0; i < 10 && watching; i++)
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+  }
+
+  // Swap rebuilt layers in between frames. Must run on the graphics thread.
+  void applyReloadedLayers()
+  {
+    std::vector<std::unique_ptr<ReloadedLayer>> layers;
+    std::vector<DerivedLayers> derived;
+    {
+      std::lock_guard<std::mutex> lock(reloadLock);
+      layers.swap(reloadedLayers);
+      derived.swap(reloadedDerived);
+    }
+
+    for (auto &layer : layers)
+    {
+      int d = layer->year, p = layer->stressor;
+      pic[d][p].vertices().swap(layer->mesh.vertices());
+      pic[d][p].colors().swap(layer->mesh.colors());
+      pic[d][p].update();
+      data_color[d][p] = layer->color;
+      std::cout << "Reloaded " << stressorFiles[p].name << " " << d + 2003 << " "
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - layer->detected).count()
+                << " s after the change was first seen" << std::endl;
+    }
+    if (!derived.empty())
+    {
+      auto uploadStart = std::chrono::steady_clock::now();
+      for (auto &layer : derived)
+        applyDerivedLayers(layer);
+      std::cout << "Uploaded trend/anomaly layers of " << derived.size() << " stressor(s) in "
+                << std::chrono::duration<double>(std::chrono::steady_clock::now() - uploadStart).count()
+                << " s" << std::endl;
+    }
+  }
+
+  void summarizeStats()
+  {
+    for (int p = 0; p < numStressors; p++)
+    {
+      stressorStats[p] = RasterStats();
+      for (int d = 0; d < numYears; d++)
+        stressorStats[p].add(rasterStats[d][p]);
+    }
+  }
+
+  // Write per-stressor and per-year statistics next to the rasters. Only the
+  // primary writes, into a temporary file renamed over stats.csv once complete,
+  // so nodes sharing the data directory never race or read a partial file.
+  void saveStats()
+  {
+    if (!isPrimary())
+      return;
+    // stressor names come from the CHI tables
+    assert(numStressors <= stressors);
+    const std::string path = "data/chi/stats.csv";
+    const std::string tmpPath = path + ".tmp";
+    std::ofstream out(tmpPath);
+    if (!out)
+    {
+      std::cerr << "failed to write " << tmpPath << std::endl;
+      return;
+    }
+    out << "stressor,year,ocean_cells,mean,p50,p90,p95,p99,max";
+    for (int v = 0; v < 256; v++)
+      out << ",h" << v;
+    out << "\n";
+    auto writeRow = [&](int p, const std::string &year, const RasterStats &stats)
+    {
+      out << stressorFiles[p].name << "," << year << "," << stats.oceanCells << "," << stats.mean
+          << "," << stats.percentile(0.5) << "," << stats.percentile(0.9)
+          << "," << stats.percentile(0.95) << "," << stats.percentile(0.99)
+          << "," << stats.percentile(1.0);
+      for (int v = 0; v < 256; v++)
+        out << "," << stats.histogram[v];
+      out << "\n";
+    };
+    for (int p = 0; p < numStressors; p++)
+    {
+      writeRow(p, "all", stressorStats[p]);
+      for (int d = 0; d < numYears; d++)
+        writeRow(p, std::to_string(d + 2003), rasterStats[d][p]);
+    }
+    out.close();
+    if (!out)
+    {
+      std::cerr << "failed to write " << tmpPath << std::endl;
+      std::remove(tmpPath.c_str());
+      return;
+    }
+#ifdef _WIN32
+    std::remove(path.c_str()); // rename does not replace existing files on Windows
+#endif
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0)
+      std::cerr << "failed to replace " << path << std::endl;
+  }
+
+  void onExit() override
+  {
+    watching = false;
+    if (reloadThread.joinable())
+      reloadThread.join();
+  }
+
+  void computeDerivedLayers(int p)
+  {
+    DerivedLayers layers = deriveLayers(p);
+    applyDerivedLayers(layers);
+  }
+
+  // Swap derived points into the trend / anomaly meshes, one mesh per band.
+  // Graphics thread only.
+  void applyDerivedLayers(DerivedLayers &layers)
+  {
+    const int p = layers.stressor;
+    const size_t numBands = layers.bands.size();
+    if (trendMesh[p].size() != numBands)
+    {
+      trendMesh[p] = std::vector<VAOMesh>(numBands);
+      for (int d = 0; d < numYears; d++)
+        anomalyMesh[d][p] = std::vector<VAOMesh>(numBands);
+    }
+    for (size_t b = 0; b < numBands; b++)
+    {
+      DerivedBand &band = layers.bands[b];
+      trendMesh[p][b].primitive(Mesh::POINTS);
+      trendMesh[p][b].vertices().swap(band.trendVerts);
+      trendMesh[p][b].colors().swap(band.trendColors);
+      trendMesh[p][b].update();
+      for (int d = 0; d < numYears; d++)
+      {
+        anomalyMesh[d][p][b].primitive(Mesh::POINTS);
+        anomalyMesh[d][p][b].vertices().swap(band.anomalyVerts[d]);
+        anomalyMesh[d][p][b].colors().swap(band.anomalyColors[d]);
+        anomalyMesh[d][p][b].update();
+      }
+    }
+  }
+
+  // Least-squares slope and residual anomaly of every ocean cell of stressor p
+  // across all years. Only reads the rasters, so it can run off the render thread.
+  // Rows are split into bands, one per hardware thread. Each worker allocates
+  // and fills the points of its own band, which becomes a mesh of its own, so
+  // nothing is copied or zero-filled on a single thread. The trend colors wait
+  // for a second pass, once the slope percentile over all bands is known.
+  DerivedLayers deriveLayers(int p)
+  {
+    const int W = data_W[p], H = data_H[p];
+    DerivedLayers layers;
+    layers.stressor = p;
+    bool valid = W > 0 && H > 0 && numYears > 2;
+    for (int d = 0; d < numYears; d++)
+    {
+      if (oceanData[d][p].width != W || oceanData[d][p].height != H)
+        valid = false;
+    }
+    if (!valid)
+    {
+      std::cerr << "skipping trend for stressor " << p << ": missing or mismatched years" << std::endl;
+      return layers;
+    }
+
+    std::vector<float> sinPhi(W), cosPhi(W);
+    for (int column = 0; column < W; column++)
+    {
+      double phi = column * M_2PI / W;
+      sinPhi[column] = sin(phi);
+      cosPhi[column] = cos(phi);
+    }
+
+    // Largest possible |slope| of 8-bit values, the range of the slope histogram
+    const float xMean = 0.5f * (numYears - 1);
+    float sxx = 0, sumAbsX = 0;
+    for (int d = 0; d < numYears; d++)
+    {
+      sxx += (d - xMean) * (d - xMean);
+      sumAbsX += std::abs(d - xMean);
+    }
+    const float slopeMax = 255 * sumAbsX / sxx;
+
+    const int numThreads = std::max(1, std::min(H, int(std::thread::hardware_concurrency())));
+    layers.bands.resize(numThreads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; t++)
+    {
+      workers.emplace_back([&, t]()
+                           { deriveRows(p, H * t / numThreads, H * (t + 1) / numThreads,
+                                        sinPhi, cosPhi, slopeMax, layers.bands[t]); });
+    }
+    for (auto &w : workers)
+      w.join();
+    workers.clear();
+
+    // Normalize slopes by their 98th percentile so a few outliers don't wash out the ramp
+    std::vector<long long> histogram(slopeBins, 0);
+    long long slopeCount = 0;
+    for (auto &band : layers.bands)
+    {
+      for (int b = 0; b < slopeBins; b++)
+      {
+        histogram[b] += band.slopeHistogram[b];
+        slopeCount += band.slopeHistogram[b];
+      }
+    }
+    float slopeScale = 1;
+    long long count = 0;
+    for (int b = 0; b < slopeBins && slopeCount > 0; b++)
+    {
+      count += histogram[b];
+      if (count >= 0.98 * slopeCount)
+      {
+        slopeScale = (b + 1) * slopeMax / slopeBins;
+        break;
+      }
+    }
+
+    // Trend colors by slope, red where impact is increasing, blue where it is decreasing
+    const int lutSize = 1024;
+    std::vector<Color> slopeColors(lutSize);
+    for (int i = 0; i < lutSize; i++)
+    {
+      float v = 2.f * i / (lutSize - 1) - 1;
+      slopeColors[i] = HSV(v > 0 ? 0.0 : 0.6, std::abs(v), 0.4 + 0.6 * std::abs(v));
+    }
+
+    const float lutScale = 0.5f * (lutSize - 1) / slopeScale;
+    for (int t = 0; t < numThreads; t++)
+    {
+      workers.emplace_back([&, t]()
+                           {
+                             DerivedBand &band = layers.bands[t];
+                             const size_t n = band.trendSlope.size();
+                             band.trendColors.resize(n);
+                             for (size_t k = 0; k < n; k++)
+                             {
+                               float i = (lutSize - 1) * 0.5f + band.trendSlope[k] * lutScale;
+                               band.trendColors[k] = slopeColors[int(std::max(0.f, std::min(lutSize - 1.f, i)))];
+                             }
+                             std::vector<float>().swap(band.trendSlope);
+                             std::vector<long long>().swap(band.slopeHistogram); });
+    }
+    for (auto &w : workers)
+      w.join();
+    return layers;
+  }
+
+  // Fit one band of rows. Year values of a row are unpacked into contiguous
+  // planes first so every per-cell reduction is a straight loop over floats.
+  // Trend points are placed here; their slopes are kept for deriveLayers() to color.
+  void deriveRows(int p, int rowBegin, int rowEnd,
+                  const std::vector<float> &sinPhi, const std::vector<float> &cosPhi,
+                  float slopeMax, DerivedBand &out)
+  {
+    const int W = data_W[p], H = data_H[p];
+    const float dist = 2.002 + 0.001 * p;
+    const float xMean = 0.5f * (numYears - 1);
+    float sxx = 0;
+    for (int d = 0; d < numYears; d++)
+      sxx += (d - xMean) * (d - xMean);
+    const float binScale = slopeBins / slopeMax;
+    // compare squared residuals against anomalyZ^2 * variance, no per-cell division or sqrt
+    const float zz = anomalyZ * anomalyZ / (numYears - 2);
+    // below half a step of the 8-bit data the fit is exact up to rounding
+    const float minSse = 0.25f * (numYears - 2);
+
+    // reserved, not resized: the pages are first touched by this thread as points are appended
+    out.trendVerts.reserve(size_t(rowEnd - rowBegin) * W);
+    out.trendSlope.reserve(size_t(rowEnd - rowBegin) * W);
+    out.slopeHistogram.assign(slopeBins, 0);
+    out.anomalyVerts.resize(numYears);
+    out.anomalyColors.resize(numYears);
+
+    std::vector<float> plane(size_t(numYears) * W);
+    std::vector<float> sy(W), sxy(W), peak(W), sse(W), mean(W), slope(W), limit(W);
+    std::vector<unsigned> rowColumn(W);
+    std::vector<float> rowSlope(W);
+    for (int row = rowBegin; row < rowEnd; row++)
+    {
+      std::fill(sy.begin(), sy.end(), 0.f);
+      std::fill(sxy.begin(), sxy.end(), 0.f);
+      std::fill(peak.begin(), peak.end(), 0.f);
+      std::fill(sse.begin(), sse.end(), 0.f);
+
+      // images are stored top row first
+      const size_t offset = size_t(H - row - 1) * W;
+      for (int d = 0; d < numYears; d++)
+      {
+        const unsigned char *src = oceanData[d][p].values.data() + offset;
+        float *y = plane.data() + size_t(d) * W;
+        const float x = d - xMean;
+        for (int c = 0; c < W; c++)
+        {
+          y[c] = src[c];
+          sy[c] += y[c];
+          sxy[c] += x * y[c];
+          peak[c] = std::max(peak[c], y[c]);
+        }
+      }
+      for (int c = 0; c < W; c++)
+      {
+        mean[c] = sy[c] / numYears;
+        slope[c] = sxy[c] / sxx;
+      }
+      for (int d = 0; d < numYears; d++)
+      {
+        const float *y = plane.data() + size_t(d) * W;
+        const float x = d - xMean;
+        for (int c = 0; c < W; c++)
+        {
+          float r = y[c] - mean[c] - slope[c] * x;
+          sse[c] += r * r;
+        }
+      }
+      for (int c = 0; c < W; c++)
+        limit[c] = sse[c] >= minSse ? zz * sse[c] : INFINITY;
+
+      // compact the ocean cells of the row without branching, then append them in bulk
+      int count = 0;
+      for (int c = 0; c < W; c++)
+      {
+        rowColumn[count] = c;
+        rowSlope[count] = slope[c];
+        count += peak[c] > 0;
+      }
+      for (int i = 0; i < count; i++)
+      {
+        if (rowSlope[i] != 0)
+          out.slopeHistogram[std::min(slopeBins - 1, int(std::abs(rowSlope[i]) * binScale))]++;
+      }
+      out.trendSlope.insert(out.trendSlope.end(), rowSlope.begin(), rowSlope.begin() + count);
+
+      double theta = row * M_PI / H;
+      float sinTheta = sin(theta);
+      float cosTheta = cos(theta);
+      for (int i = 0; i < count; i++)
+      {
+        const unsigned c = rowColumn[i];
+        out.trendVerts.push_back(Vec3f(sinPhi[c] * sinTheta * dist, -cosTheta * dist,
+                                       cosPhi[c] * sinTheta * dist));
+      }
+      for (int d = 0; d < numYears; d++)
+      {
+        const float *y = plane.data() + size_t(d) * W;
+        const float x = d - xMean;
+        int hits = 0;
+        for (int c = 0; c < W; c++)
+        {
+          float r = y[c] - mean[c] - slope[c] * x;
+          hits += r * r > limit[c];
+        }
+        if (hits == 0)
+          continue;
+        for (int c = 0; c < W; c++)
+        {
+          float r = y[c] - mean[c] - slope[c] * x;
+          if (r * r <= limit[c])
+            continue;
+          float z = r / sqrt(sse[c] / (numYears - 2));
+          float strength = std::min((std::abs(z) - anomalyZ) / anomalyZ, 1.f);
+          out.anomalyVerts[d].push_back(Vec3f(sinPhi[c] * sinTheta * dist, -cosTheta * dist,
+                                              cosPhi[c] * sinTheta * dist));
+          out.anomalyColors[d].push_back(HSV(z > 0 ? 0.02 : 0.6, 0.9, 0.5 + 0.5 * strength));
+        }
+      }
+    }
+  }
+
   void onAnimate(double dt) override
   {
+    applyReloadedLayers();
+    if (scalingSuite)
+      return; // the suite sets the drawn layers itself, see nextScalingRun()
     if (isPrimary())
     {
       Vec3f point_you_want_to_see = Vec3f(0, 0, 0); // examplary point that you want to see
@@ -480,9 +1417,9 @@ struct SensoriumApp : public DistributedAppWithState<State>
       // morph_year = year - floor(year);
       // if (morph_year)
       {
-        for (int p = 0; p < stressors; p++)
+        for (int p = 0; p < numStressors; p++)
         {
-          for (int d = 0; d < years; d++)
+          for (int d = 0; d < numYears; d++)
           {
             data_color[d][p].a = year - floor(year);
             pic[d][p].color(data_color[d][p]);
@@ -523,6 +1460,7 @@ struct SensoriumApp : public DistributedAppWithState<State>
       state().swtch[9] = s_dh;
       state().swtch[10] = s_oc;
       state().swtch[11] = s_ci;
+      state().layerMode = layerMode.get();
     }    // prim end
     else // renderer
     {
@@ -576,7 +1514,7 @@ struct SensoriumApp : public DistributedAppWithState<State>
     g.popMatrix();
 
     // Draw data
-    for (int j = 0; j < stressors; j++)
+    for (int j = 0; j < std::min(stressors, numStressors); j++)
     {
       if (state().swtch[j])
       {
@@ -598,10 +1536,24 @@ struct SensoriumApp : public DistributedAppWithState<State>
         {
           g.scale(1);
         }
-        g.draw(pic[(int)state().year - 2003][j]); // only needed if we go inside the earth
+        if (state().layerMode == LAYER_TREND)
+        {
+          for (auto &band : trendMesh[j])
+            g.draw(band);
+        }
+        else if (state().layerMode == LAYER_ANOMALY)
+        {
+          for (auto &band : anomalyMesh[(int)state().year - 2003][j])
+            g.draw(band);
+        }
+        else
+          g.draw(pic[(int)state().year - 2003][j]); // only needed if we go inside the earth
         g.popMatrix();
       }
     }
+
+    if (scalingSuite)
+      drawScalingFrame();
   }
 
   bool onKeyDown(const Keyboard &k) override
@@ -713,6 +1665,12 @@ struct SensoriumApp : public DistributedAppWithState<State>
     case 'n':
       state().swtch[11] = !state().swtch[11];
       return true;
+    case 't':
+      layerMode.set(layerMode.get() == LAYER_TREND ? LAYER_YEAR : LAYER_TREND);
+      return true;
+    case 'y':
+      layerMode.set(layerMode.get() == LAYER_ANOMALY ? LAYER_YEAR : LAYER_ANOMALY);
+      return true;
     case '9':
       state().molph = !state().molph;
       year = 2003;
@@ -731,9 +1689,58 @@ struct SensoriumApp : public DistributedAppWithState<State>
 
 };
 
-int main()
+int main(int argc, char *argv[])
 {
   SensoriumApp app;
+  // --scaling runs the synthetic scaling suite, the other flags shape its base dataset
+  for (int i = 1; i < argc; i++)
+  {
+    std::string arg = argv[i];
+    bool hasValue = i + 1 < argc;
+    if (arg == "--scaling")
+      app.scalingSuite = true;
+    else if (arg == "--axis" && hasValue)
+    {
+      app.scalingAxis = argv[++i];
+      if (app.scalingAxis != "steps" && app.scalingAxis != "stressors" &&
+          app.scalingAxis != "resolution")
+      {
+        std::cerr << "unknown --axis " << app.scalingAxis
+                  << ", expected steps, stressors or resolution" << std::endl;
+        return 1;
+      }
+    }
+    else if (arg == "--width" && hasValue)
+      app.scalingBase.width = atoi(argv[++i]);
+    else if (arg == "--height" && hasValue)
+      app.scalingBase.height = atoi(argv[++i]);
+    else if (arg == "--steps" && hasValue)
+      app.scalingBase.years = atoi(argv[++i]);
+    else if (arg == "--stressors" && hasValue)
+      app.scalingBase.stressors = atoi(argv[++i]);
+    else if (arg == "--sparsity" && hasValue)
+      app.scalingBase.sparsity = atof(argv[++i]);
+    else if (arg == "--coherence" && hasValue)
+      app.scalingBase.coherence = atof(argv[++i]);
+    else if (arg == "--max-gb" && hasValue)
+      app.scalingMaxGB = atof(argv[++i]);
+    else if (arg == "--max-gpu-gb" && hasValue)
+      app.scalingMaxGpuGB = atof(argv[++i]);
+    else
+      std::cerr << "ignoring argument " << arg << std::endl;
+  }
+  const SyntheticDataset &base = app.scalingBase;
+  if (base.width <= 0 || base.height <= 0 || base.years <= 0 || base.stressors <= 0)
+  {
+    std::cerr << "--width, --height, --steps and --stressors must be positive" << std::endl;
+    return 1;
+  }
+  if (!(base.sparsity >= 0 && base.sparsity <= 1) || !(base.coherence >= 0 && base.coherence <= 1))
+  {
+    std::cerr << "--sparsity and --coherence must be between 0 and 1" << std::endl;
+    return 1;
+  }
   app.dimensions(1200, 800);
   app.start();
+  return 0;
 }